@@ -12,10 +12,14 @@
 
 #define HAVE_JOYSTICK
 
+#define _POSIX_C_SOURCE 200112L // clock_gettime, clock_nanosleep
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
 #include <math.h>
+#include <time.h>
+#include <errno.h>
 
 #include <SDL/SDL.h>
 #include <SDL/SDL_image.h>
@@ -40,6 +44,8 @@ double line_width_joy = 0.0;
 
 int mode = 1;
 int draw_mode = 0; // 0 for lines, 1 for pixels
+int sampling = 0;  // 0 for uniform t_step, 1 for curvature-adaptive
+int exact_trig = 0; // 1 evaluates every uniform sample with cos/sin
 
 double t_step = 0.008;
 double t_step_step = 0.00000001;
@@ -57,6 +63,15 @@ double r_delta = 0.00001;
 
 double line_width = 0.6;
 
+double decimate_tol = 0.25;            // device pixels, 0 keeps every vertex
+double decimate_color_tol = 1.0 / 64;  // max colour drift along one stroke
+double sample_tol = 0.5;               // max chord error of adaptive steps, device pixels
+int sample_max = 8192;                 // adaptive samples per frame, uniform beyond that
+int sample_warned = 0;
+
+double frame_time = 16.6; // target frame time in ms, 0 runs unthrottled
+double quality = 1.0;     // lowered by the frame-time governor to hold frame_time
+
 long png = 0;
 long svg = 0;
 
@@ -140,6 +155,298 @@ void rainbow(int step, int numsteps, double *r, double *g, double *b) {
   }
 }
 
+/*
+ * Polyline decimation between curve evaluation and cairo.
+ *
+ * Points are fed in order together with their rainbow colour. A point
+ * only becomes a vertex once some point skipped since the last vertex
+ * would lie further than decimate_tol (device pixels) from the straight
+ * segment, so sub-pixel runs and nearly collinear points collapse into
+ * one segment. Vertices of the same colour are stroked as one path; the
+ * path is stroked and restarted whenever the colour drifts by more than
+ * decimate_color_tol, which keeps the transitions of rainbow(). Both
+ * tolerances are divided by quality, so a lower quality batches more
+ * segments into each stroke.
+ */
+#define PLOT_MAX_RUN 32
+
+typedef struct {
+    cairo_t *cr;
+    double tol2;             // squared tolerance in user space
+    double ctol;             // colour tolerance
+    int n;                   // points fed so far
+    int verts;               // vertices in the current path
+    double ax, ay;           // last emitted vertex
+    double bx[PLOT_MAX_RUN]; // points skipped since (ax, ay)
+    double by[PLOT_MAX_RUN];
+    int nb;
+    double colr, colg, colb; // colour of the current path
+} plot_t;
+
+void plot_begin(plot_t *pl, cairo_t *cr) {
+    double dx = decimate_tol / quality, dy = 0;
+    cairo_device_to_user_distance(cr, &dx, &dy);
+
+    pl->cr    = cr;
+    pl->tol2  = dx * dx + dy * dy;
+    pl->ctol  = decimate_color_tol / quality;
+    pl->n     = 0;
+    pl->verts = 0;
+    pl->nb    = 0;
+
+    cairo_set_line_join (cr, CAIRO_LINE_JOIN_ROUND);
+    cairo_new_path (cr);
+}
+
+void plot_vertex(plot_t *pl, double x, double y) {
+    if (draw_mode == 0) {
+        if (pl->verts == 0) cairo_move_to (pl->cr, pl->ax, pl->ay);
+        cairo_line_to (pl->cr, x, y);
+    } else {
+        cairo_new_sub_path (pl->cr);
+        cairo_arc (pl->cr, x, y, line_width, 0, 2 * M_PI);
+    }
+    pl->verts++;
+    pl->ax = x;
+    pl->ay = y;
+}
+
+/* emit the pending vertex, if any, and stroke the current path */
+void plot_flush(plot_t *pl) {
+    if (pl->nb > 0) {
+        plot_vertex(pl, pl->bx[pl->nb - 1], pl->by[pl->nb - 1]);
+        pl->nb = 0;
+    }
+    if (pl->verts > 0) {
+        cairo_set_source_rgb (pl->cr, pl->colr, pl->colg, pl->colb);
+        cairo_stroke (pl->cr);
+        pl->verts = 0;
+    }
+}
+
+/* are all skipped points within tolerance of the segment (ax, ay)-(x, y)? */
+int plot_fits(plot_t *pl, double x, double y) {
+    double sx = x - pl->ax, sy = y - pl->ay;
+    double len2 = sx * sx + sy * sy;
+    int k;
+
+    for (k = 0; k < pl->nb; k++) {
+        double qx = pl->bx[k] - pl->ax, qy = pl->by[k] - pl->ay;
+        double u = len2 > 0 ? (qx * sx + qy * sy) / len2 : 0;
+        if (u < 0) u = 0;
+        if (u > 1) u = 1;
+        qx -= u * sx;
+        qy -= u * sy;
+        if (qx * qx + qy * qy > pl->tol2) return 0;
+    }
+    return 1;
+}
+
+void plot_point(plot_t *pl, double x, double y, double colr, double colg, double colb) {
+    if (pl->n++ == 0) {
+        pl->ax = x;
+        pl->ay = y;
+        pl->colr = colr; pl->colg = colg; pl->colb = colb;
+        return;
+    }
+
+    if (fabs(colr - pl->colr) > pl->ctol ||
+        fabs(colg - pl->colg) > pl->ctol ||
+        fabs(colb - pl->colb) > pl->ctol) {
+        plot_flush(pl);
+        pl->colr = colr; pl->colg = colg; pl->colb = colb;
+    }
+
+    if (draw_mode != 0) {
+        /* dots: only merge points that land on the previous dot */
+        double dx = x - pl->ax, dy = y - pl->ay;
+        if (pl->verts > 0 && dx * dx + dy * dy <= pl->tol2) return;
+        plot_vertex(pl, x, y);
+        return;
+    }
+
+    if (pl->nb == PLOT_MAX_RUN || !plot_fits(pl, x, y)) {
+        plot_vertex(pl, pl->bx[pl->nb - 1], pl->by[pl->nb - 1]);
+        pl->nb = 0;
+    }
+    pl->bx[pl->nb] = x;
+    pl->by[pl->nb] = y;
+    pl->nb++;
+}
+
+void plot_end(plot_t *pl) {
+    plot_flush(pl);
+}
+
+/*
+ * Both rosettes are sums of rotating vectors a * (cos(w t), sin(w t)),
+ * scaled by 4 around the screen centre.
+ */
+#define CURVE_MAX_TERMS 3
+
+typedef struct {
+    int terms;
+    double a[CURVE_MAX_TERMS];
+    double w[CURVE_MAX_TERMS];
+    double cx, cy;
+} curve_t;
+
+/* point at t and, if k2 is given, the length of the second derivative */
+void curve_eval(const curve_t *c, double t, double *x, double *y, double *k2) {
+    double px = 0, py = 0, ax = 0, ay = 0;
+    int j;
+
+    for (j = 0; j < c->terms; j++) {
+        double cs = cos(c->w[j] * t), sn = sin(c->w[j] * t);
+        double aw2 = c->a[j] * c->w[j] * c->w[j];
+        px += c->a[j] * cs;
+        py += c->a[j] * sn;
+        ax += aw2 * cs;
+        ay += aw2 * sn;
+    }
+    *x = px * 4 + c->cx;
+    *y = py * 4 + c->cy;
+    if (k2) *k2 = 4 * sqrt(ax * ax + ay * ay);
+}
+
+void curve_color(double t, double t_step, double *colr, double *colg, double *colb) {
+    *colr = 0.4;
+    *colg = 1;
+    *colb = 0.4;
+    rainbow((int)(t / t_step), (int)(2 * M_PI / t_step), colr, colg, colb);
+}
+
+/*
+ * Uniform steps of t_step, the classic look.
+ *
+ * Unless exact_trig is set, each term keeps its phase z = e^{i w t} and
+ * advances it by the fixed rotation e^{i w t_step}, a complex multiply
+ * instead of cos/sin of an argument that reaches thousands of radians.
+ * One Newton step per sample pulls |z| back to 1, so only the phase
+ * drifts, by a few ulps per sample. Resyncing from cos/sin every
+ * PHASE_RESYNC samples bounds that at ~1e-13 rad, far below a pixel.
+ */
+#define PHASE_RESYNC 256
+
+void trace_uniform(plot_t *pl, const curve_t *c, double t_step) {
+    double zr[CURVE_MAX_TERMS], zi[CURVE_MAX_TERMS];
+    double rr[CURVE_MAX_TERMS], ri[CURVE_MAX_TERMS];
+    double t = 0;
+    int i = 0, j;
+
+    for (j = 0; j < c->terms; j++) {
+        rr[j] = cos(c->w[j] * t_step);
+        ri[j] = sin(c->w[j] * t_step);
+    }
+
+    while ( t < 2 * M_PI) {
+        t += t_step;
+        double x = 0, y = 0;
+
+        for (j = 0; j < c->terms; j++) {
+            if (exact_trig || i % PHASE_RESYNC == 0) {
+                zr[j] = cos(c->w[j] * t);
+                zi[j] = sin(c->w[j] * t);
+            } else {
+                double re = zr[j] * rr[j] - zi[j] * ri[j];
+                double im = zr[j] * ri[j] + zi[j] * rr[j];
+                double k = 1.5 - 0.5 * (re * re + im * im);
+                zr[j] = re * k;
+                zi[j] = im * k;
+            }
+            x += c->a[j] * zr[j];
+            y += c->a[j] * zi[j];
+        }
+        x = x * 4 + c->cx;
+        y = y * 4 + c->cy;
+
+        double colr = 0.4, colg = 1, colb = 0.4;
+        // printf("%d %d\n", i, (int)(2 * M_PI / t_step));
+        rainbow(i, (int)(2 * M_PI / t_step), &colr, &colg, &colb);
+        plot_point(pl, x, y, colr, colg, colb);
+        i++;
+    }
+}
+
+/*
+ * Steps sized so that the chord error h^2/8 * |c''| stays below
+ * sample_tol device pixels. |c''| is taken at both ends of a trial step
+ * and the step is shrunk and retried while the far end bends much harder.
+ *
+ * Resolving the fast harmonic takes far more samples than the uniform
+ * walk for most of the mouse range (20134 vs 785 segments for mode 0 at
+ * the defaults), so the walk is capped at sample_max samples. The cap is
+ * checked against the analytic bound |c''| <= 4 * sum |a| w^2. When that
+ * bound needs more samples, the fast harmonic dominates |c''| everywhere
+ * and there is nothing to adapt to: the curve falls back to the uniform
+ * walk at 2 pi / sample_max, warning once per run.
+ */
+#define ADAPTIVE_MAX_STEP (2 * M_PI / 64)
+
+double adaptive_step(double k2, double tol) {
+    double h = k2 > 0 ? sqrt(8 * tol / k2) : ADAPTIVE_MAX_STEP;
+    if (h > ADAPTIVE_MAX_STEP) h = ADAPTIVE_MAX_STEP;
+    return h;
+}
+
+void trace_adaptive(plot_t *pl, const curve_t *c, double t_step) {
+    double sx = 1, sy = 0;
+    cairo_user_to_device_distance(pl->cr, &sx, &sy);
+    double tol = sample_tol / quality / sqrt(sx * sx + sy * sy);
+
+    double k2max = 0, h_min = 2 * M_PI / (sample_max * quality);
+    int j;
+    for (j = 0; j < c->terms; j++) {
+        k2max += 4 * fabs(c->a[j]) * c->w[j] * c->w[j];
+    }
+    if (tol < k2max * h_min * h_min / 8) {
+        if (!sample_warned) {
+            printf("Warning: adaptive sampling capped at %d samples, using uniform steps\n",
+                   (int)(sample_max * quality));
+            sample_warned = 1;
+        }
+        trace_uniform(pl, c, h_min);
+        return;
+    }
+
+    double t = 0, x, y, k2;
+    double colr, colg, colb;
+    curve_eval(c, t, &x, &y, &k2);
+    curve_color(t, t_step, &colr, &colg, &colb);
+    plot_point(pl, x, y, colr, colg, colb);
+
+    while (t < 2 * M_PI) {
+        double h = adaptive_step(k2, tol);
+        double tn, k2n;
+
+        for (;;) {
+            tn = t + h < 2 * M_PI ? t + h : 2 * M_PI;
+            curve_eval(c, tn, &x, &y, &k2n);
+            double hn = adaptive_step(k2n > k2 ? k2n : k2, tol);
+            if (hn >= 0.8 * h) break;
+            h = hn;
+        }
+
+        t = tn;
+        k2 = k2n;
+        curve_color(t, t_step, &colr, &colg, &colb);
+        plot_point(pl, x, y, colr, colg, colb);
+    }
+}
+
+void trace(cairo_t *cr, const curve_t *c, double t_step) {
+    plot_t pl;
+    plot_begin(&pl, cr);
+
+    if (sampling == 0) {
+        trace_uniform(&pl, c, t_step);
+    } else {
+        trace_adaptive(&pl, c, t_step);
+    }
+
+    plot_end(&pl);
+}
+
 void guilloche(cairo_t *cr, int width, int height) {
         /* who doesn't want all those nice line settings :) */
         cairo_set_line_cap (cr, CAIRO_LINE_CAP_ROUND);
@@ -148,44 +455,9 @@ void guilloche(cairo_t *cr, int width, int height) {
 
         p = height * 0.07;
 
-        double oldx, oldy;
-        int first = 0;
-        double t = 0;
-	int i = 0;
-	
-        while ( t < 2 * M_PI) {
-                t += t_step;
-                double x = (R+r)*cos(t)+(r+p)*cos((R+r)/r*t);
-                double y = (R+r)*sin(t)+(r+p)*sin((R+r)/r*t);
-
-                x = x * 4 + width / 2;
-                y = y * 4 + height / 2;
-
-		double a = 1;
-		double colr = 0.4;
-		double colg = a;
-		double colb = 0.4;
-
-		// printf("%d %d\n", i, (int)(2 * M_PI / t_step));
-		rainbow(i, (int)(2 * M_PI / t_step), &colr, &colg, &colb);
-		cairo_set_source_rgb (cr, colr, colg, colb);
-		
-                if (first == 1) {
-		  if (draw_mode == 0) {
-		    cairo_move_to (cr, oldx, oldy);
-		    cairo_line_to (cr, x, y);
-		  } else {
-		    cairo_arc(cr, x, y, line_width, 0, 2 * M_PI);
-		  }
-		  cairo_stroke (cr);
-                } else {
-                        first = 1;
-                }
-
-                oldx = x;
-                oldy = y;
-		i++;
-        }
+        curve_t c = { 2, { R+r, r+p }, { 1, (R+r)/r }, width / 2, height / 2 };
+        trace(cr, &c, t_step);
+
         t_step += t_step_step;
         R += R_step;
 }
@@ -204,43 +476,9 @@ void guilloche2(cairo_t *cr, int width, int height) {
     cairo_set_line_width (cr, line_width);
     cairo_set_source_rgba (cr, 0.5, 1, 0.5, 1.0);
 
-    double oldx, oldy;
-    int first = 0;
-    double t = 0;
-    int i = 0;
-    while ( t < 2 * M_PI) {
-        t += t_step;
-        double x =(R+r)*cos(m*t)+(r+p)*cos(m*t*(R+r)/r)+Q*cos(n*t);
-        double y =(R+r)*sin(m*t)+(r+p)*sin(m*t*(R+r)/r)+Q*sin(n*t);
-        
-        x = x * 4 + width / 2;
-        y = y * 4 + height / 2;
-        
-	double a = 1;
-	double colr = 0.4;
-	double colg = a;
-	double colb = 0.4;
-	// printf("%d %d\n", i, (int)(2 * M_PI / t_step));
-	rainbow(i, (int)(2 * M_PI / t_step), &colr, &colg, &colb);
-	cairo_set_source_rgb (cr, colr, colg, colb);
-	    
-        if (first == 1) {
-	    if (draw_mode == 0) {
-	      cairo_move_to (cr, oldx, oldy);
-	      cairo_line_to (cr, x, y);
-	    } else {
-	      cairo_arc(cr, x, y, line_width, 0, 2 * M_PI);
-	    }
-
-            cairo_stroke (cr);
-        } else {
-            first = 1;
-        }
-        
-        oldx = x;
-        oldy = y;
-	i++;
-    }
+    curve_t c = { 3, { R+r, r+p, Q }, { m, m*(R+r)/r, n }, width / 2, height / 2 };
+    trace(cr, &c, t_step);
+
     t_step += t_step_step;
     R += R_step;
 }
@@ -263,6 +501,94 @@ double sgn(double x) {
     return 0.0;
 }
 
+/*
+ * Frame-time governor.
+ *
+ * Each frame the draw phase is given what is left of frame_time after
+ * presenting and event handling. Quality drops proportionally when the
+ * draw phase overruns and creeps back up when it has headroom. Quality
+ * widens the colour tolerance of the plot stage, so fewer and longer
+ * strokes reach cairo, loosens the adaptive chord tolerance and lowers
+ * the sample cap. Below QUALITY_SCALE the frame is also rendered at
+ * reduced resolution, in steps of 1/8 so the surface kept across frames
+ * is only reallocated when the step changes. The rest of the frame is
+ * slept away against an absolute deadline.
+ */
+#define QUALITY_MIN   0.25
+#define QUALITY_SCALE 0.5
+
+double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+double render_scale() {
+    double scale = floor(quality / QUALITY_SCALE * 8) / 8;
+    if (scale < 0.5) scale = 0.5;
+    return scale < 1.0 ? scale : 1.0;
+}
+
+void governor_update(double draw_ms, double other_ms) {
+    double budget = frame_time - other_ms;
+    if (budget < frame_time * 0.25) budget = frame_time * 0.25;
+
+    if (draw_ms > budget * 0.9) {
+        double f = budget * 0.9 / draw_ms;
+        quality *= f < 0.7 ? 0.7 : f;
+    } else if (draw_ms < budget * 0.6) {
+        quality *= 1.05;
+    }
+
+    if (quality < QUALITY_MIN) quality = QUALITY_MIN;
+    if (quality > 1.0) quality = 1.0;
+}
+
+/* sleep until deadline, returns the deadline of the next frame */
+double governor_sleep(double deadline) {
+    double now = now_ms();
+    if (now >= deadline) return now + frame_time;
+
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(deadline / 1e3);
+    ts.tv_nsec = (long)((deadline - ts.tv_sec * 1e3) * 1e6);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+
+    return deadline + frame_time;
+}
+
+cairo_surface_t *small_surface = NULL;
+
+/* draw at a fraction of the resolution and scale the result up */
+void draw_scaled(cairo_t *cr, int width, int height, double scale) {
+    if (scale >= 1.0) {
+        draw(cr, width, height);
+        return;
+    }
+
+    int w = width * scale, h = height * scale;
+    if (small_surface == NULL ||
+        cairo_image_surface_get_width(small_surface) != w ||
+        cairo_image_surface_get_height(small_surface) != h) {
+        if (small_surface) cairo_surface_destroy(small_surface);
+        small_surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, w, h);
+    }
+
+    cairo_surface_t *small = small_surface;
+    cairo_t *cr_small = cairo_create(small);
+    cairo_scale(cr_small, (double)w / width, (double)h / height);
+    draw(cr_small, width, height);
+    cairo_destroy(cr_small);
+
+    cairo_save(cr);
+    cairo_scale(cr, (double)width / w, (double)height / h);
+    cairo_set_source_surface(cr, small, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+    cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_PAD);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
 SDL_Cursor *sdl_cursor;
 
 void hide_cursor() {
@@ -292,6 +618,23 @@ int main (int argc, char **argv) {
             videoFlags |= SDL_FULLSCREEN;
         } else if (OPTION_SET("--screenshot", "-s")) {
             do_png = 1;
+        } else if (OPTION_SET("--adaptive", "-a")) {
+            sampling = 1;
+        } else if (OPTION_SET("--exact-trig", "-x")) {
+            exact_trig = 1;
+        } else if (OPTION_SET("--chord-tol", "-e") && i+1 < argc) {
+            sample_tol = atof(argv[i+1]);
+            OPTION_VALUE_PROCESSED;
+        } else if (OPTION_SET("--max-samples", "-n") && i+1 < argc) {
+            sample_max = atoi(argv[i+1]);
+            if (sample_max < 64) sample_max = 64;
+            OPTION_VALUE_PROCESSED;
+        } else if (OPTION_SET("--tolerance", "-t") && i+1 < argc) {
+            decimate_tol = atof(argv[i+1]);
+            OPTION_VALUE_PROCESSED;
+        } else if (OPTION_SET("--frame-time", "-F") && i+1 < argc) {
+            frame_time = atof(argv[i+1]);
+            OPTION_VALUE_PROCESSED;
         } else if (OPTION_SET("--help", "-h")) {
             do_help = 1;
         } else {
@@ -304,7 +647,13 @@ int main (int argc, char **argv) {
         fprintf(stderr, "Usage: %s [OPTIONS]\n\n"
                 " Where [OPTIONS] are zero or more of the following:\n\n"
                 "    [-f|--fullscreen]           Fullscreen mode\n"
-                "    [-s|--screenshot]           Save screenshots\n"
+                "    [-s|--screenshot]           Save screenshots at full quality\n"
+                "    [-a|--adaptive]             Curvature-adaptive sampling\n"
+                "    [-e|--chord-tol <px>]       Adaptive chord error (default 0.5)\n"
+                "    [-n|--max-samples <n>]      Adaptive samples per frame (default 8192)\n"
+                "    [-x|--exact-trig]           Evaluate every sample with cos/sin\n"
+                "    [-t|--tolerance <px>]       Polyline decimation tolerance (default 0.25)\n"
+                "    [-F|--frame-time <ms>]      Target frame time, 0 for unthrottled (default 16.6)\n"
                 "    [-h|--help]                 Show help information\n\n"
                 , argv[0]);
         return EXIT_SUCCESS;
@@ -358,7 +707,10 @@ int main (int argc, char **argv) {
 
     /* Our main event/draw loop */
     int done = 0;
+    double deadline = now_ms() + frame_time;
     while (!done) {
+        double t_start = now_ms();
+
         /* Clear our surface */
             // SDL_FillRect( sdl_surface, NULL, 0 );
 
@@ -378,7 +730,8 @@ int main (int argc, char **argv) {
         line_width += line_width_joy;
 #endif
         
-        draw(cr, width, height);
+        draw_scaled(cr, width, height, render_scale());
+        double t_drawn = now_ms();
 
         /******************************************************************************/
         /*** Cleanup our cairo surface, copy it to the screen, deal with SDL events ***/
@@ -412,7 +765,10 @@ int main (int argc, char **argv) {
                         cairo_surface_t *surface = cairo_svg_surface_create(svgfile, width, height);
                         //cairo_svg_surface_restrict_to_version (surface, CAIRO_SVG_VERSION_1_1);
                         cairo_t* cr_svg = cairo_create (surface);                        
+                        double q = quality;
+                        quality = 1.0;
                         draw(cr_svg, width, height);
+                        quality = q;
                         cairo_destroy(cr_svg);
                         cairo_surface_finish(surface);
                         cairo_surface_destroy(surface);
@@ -458,6 +814,8 @@ int main (int argc, char **argv) {
 		      } else {
 			draw_mode = 0;
 		      }
+                    } else if (event.key.keysym.sym == SDLK_c) {
+		      sampling = !sampling;
                     } 
 		    
                     break;
@@ -525,12 +883,19 @@ int main (int argc, char **argv) {
             png++;
         }
 
-        SDL_Delay(1); 
+        if (frame_time > 0) {
+            /* screenshots, like SVG export, are always taken at full quality */
+            if (!do_png) governor_update(t_drawn - t_start, now_ms() - t_drawn);
+            deadline = governor_sleep(deadline);
+        } else {
+            SDL_Delay(1); 
+        }
     }
 
     /* Cleanup */
     SDL_FreeCursor(sdl_cursor);
     SDL_FreeSurface(sdl_surface);
+    if (small_surface) cairo_surface_destroy(small_surface);
 
 #ifdef HAVE_JOYSTICK
     if (joy) {